@@ -0,0 +1,54 @@
+#pragma once
+
+#include "crypto_guard_ctx.h"
+#include "file_utils.h"
+
+#include <cstdint>
+#include <expected>
+#include <filesystem>
+#include <optional>
+#include <string>
+
+namespace crypto_guard {
+
+struct ChecksumCacheEntry {
+    uint64_t inode{};      // Inode of the file the checksum was calculated for
+    uint64_t size{};       // Size of the file
+    int64_t mtime_ns{};    // Modification time of the file in nanoseconds
+    std::string checksum;  // Hex encoded checksum
+
+    [[nodiscard]] bool IsSameFile(const ChecksumCacheEntry& other) const {
+        return inode == other.inode && size == other.size && mtime_ns == other.mtime_ns;
+    }
+};
+
+class ChecksumCache {
+public:
+    explicit ChecksumCache(CryptoGuardCtx& crypto_ctx);
+
+    [[nodiscard]] std::string GetChecksum(const std::filesystem::path& file);
+    [[nodiscard]] std::expected<std::string, std::string> VerifyChecksum(const std::filesystem::path& file);
+
+    // Raw access to the cached entry of the file, e.g. for inspecting the cache.
+    // The entry isn't checked against the file, so a stored stale entry is ignored by GetChecksum
+    [[nodiscard]] static std::optional<ChecksumCacheEntry> Load(const std::filesystem::path& file);
+    // Returns false if the file system doesn't support user extended attributes
+    static bool Store(const std::filesystem::path& file, const ChecksumCacheEntry& entry);
+
+private:
+    static constexpr auto kXattrName = "user.crypto_guard.checksum";
+    // Checksums of files modified more recently aren't stored: a rewrite within the same timestamp tick
+    // keeps the size and mtime, so the stale checksum would be taken for the new content
+    static constexpr int64_t kMtimeGranularityNs{2'000'000'000};
+
+    [[nodiscard]] static FileDescriptor OpenFile(const std::filesystem::path& file);
+    [[nodiscard]] static std::optional<ChecksumCacheEntry> Load(const FileDescriptor& fd);
+    static bool Store(const FileDescriptor& fd, const ChecksumCacheEntry& entry);
+    [[nodiscard]] static ChecksumCacheEntry GetFileMetadata(const FileDescriptor& fd);
+    [[nodiscard]] ChecksumCacheEntry Calculate(const FileDescriptor& fd);
+    static void Update(const FileDescriptor& fd, const ChecksumCacheEntry& entry);
+
+    CryptoGuardCtx& crypto_ctx_;
+};
+
+}  // namespace crypto_guard
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace crypto_guard {
+
+struct ArchiveEntry {
+    std::string name;          // Path relative to the packed directory
+    uint64_t offset{};         // Offset of the encrypted member from the archive beginning
+    uint64_t size{};           // Size of the encrypted member
+    uint64_t original_size{};  // Size of the member before encryption
+};
+
+class CryptoArchive {
+public:
+    // Members are encrypted in parallel by up to threads_count threads
+    static void Pack(const std::filesystem::path& input, const std::filesystem::path& archive_path,
+                     std::string_view password, size_t threads_count);
+    [[nodiscard]] static std::vector<ArchiveEntry> ReadIndex(std::istream& archive, std::string_view password);
+    static void ExtractMember(std::istream& archive, const ArchiveEntry& entry, std::ostream& out_stream,
+                              std::string_view password);
+    static void Extract(const std::filesystem::path& archive_path, const std::filesystem::path& output_dir,
+                        std::string_view password, const std::optional<std::string>& member = {});
+};
+
+}  // namespace crypto_guard
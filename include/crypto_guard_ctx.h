@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <experimental/propagate_const>
 #include <iostream>
 #include <memory>
@@ -20,8 +21,11 @@ public:
 
     void EncryptFile(std::istream& in_stream, std::ostream& out_stream, std::string_view password);
     void DecryptFile(std::istream& in_stream, std::ostream& out_stream, std::string_view password);
+    void CheckPassword(std::istream& in_stream, std::string_view password);
     std::string CalculateChecksum(std::istream& in_stream);
 
+    [[nodiscard]] static uint64_t GetEncryptedSize(uint64_t plain_size);
+
 private:
     class Impl;
 
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "crypto_guard_ctx.h"
+
+#include <experimental/propagate_const>
+#include <filesystem>
+#include <functional>
+#include <memory>
+
+namespace crypto_guard {
+
+class DirectoryWatcher {
+public:
+    using FileHandler = std::function<void(CryptoGuardCtx& crypto_ctx, const std::filesystem::path& file)>;
+    using ErrorHandler = std::function<void(const std::filesystem::path& file, const std::exception& error)>;
+
+    // Files already in the directory are handled only if handle_existing_files is set,
+    // otherwise only the files finalized after the construction are
+    DirectoryWatcher(std::filesystem::path dir, size_t workers_count, bool handle_existing_files,
+                     FileHandler file_handler, ErrorHandler error_handler);
+    ~DirectoryWatcher();
+
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    DirectoryWatcher(DirectoryWatcher&&) noexcept = default;
+    DirectoryWatcher& operator=(DirectoryWatcher&&) noexcept = default;
+
+    // Blocks until Stop is called, then waits for the already queued files to be handled
+    void Run();
+    // Async-signal-safe, so it may be called from a signal handler
+    void Stop();
+
+    // Number of files waiting for a free worker, e.g. for monitoring the backlog of a busy directory.
+    // Files being handled aren't counted, repeated events of a queued file don't add to the count
+    [[nodiscard]] size_t GetQueuedFilesCount() const;
+
+private:
+    class Impl;
+
+    std::experimental::propagate_const<std::unique_ptr<Impl>> impl_;
+};
+
+}  // namespace crypto_guard
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <filesystem>
+#include <utility>
+
+namespace crypto_guard {
+
+class FileDescriptor {
+public:
+    explicit FileDescriptor(int fd) : fd_{fd} {}
+    ~FileDescriptor();
+
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+
+    FileDescriptor(FileDescriptor&& other) noexcept : fd_{std::exchange(other.fd_, -1)} {}
+    FileDescriptor& operator=(FileDescriptor&&) = delete;
+
+    [[nodiscard]] int Get() const { return fd_; }
+
+private:
+    int fd_;
+};
+
+// Unique file next to the target that replaces the target only when it's complete,
+// so readers never see a partially written target
+class TempFile {
+public:
+    static constexpr std::string_view kSuffix{".part"};
+
+    explicit TempFile(std::filesystem::path target);
+    ~TempFile();
+
+    TempFile(const TempFile&) = delete;
+    TempFile& operator=(const TempFile&) = delete;
+
+    [[nodiscard]] const std::filesystem::path& GetPath() const { return path_; }
+    void Commit();
+
+private:
+    std::filesystem::path target_;
+    std::filesystem::path path_;
+    bool committed_{};
+};
+
+}  // namespace crypto_guard
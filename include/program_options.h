@@ -2,6 +2,7 @@
 
 #include <expected>
 #include <filesystem>
+#include <optional>
 #include <string>
 
 #include <boost/program_options.hpp>
@@ -10,7 +11,7 @@ namespace crypto_guard {
 
 class ProgramOptions {
 public:
-    enum class CommandType { encrypt, decrypt, checksum, LAST };
+    enum class CommandType { encrypt, decrypt, checksum, archive, extract, LAST };
 
     [[nodiscard]] static std::optional<CommandType> ParseCommandType(std::string_view type_str);
     [[nodiscard]] static std::expected<ProgramOptions, std::string> Parse(std::span<const char* const> args);
@@ -21,6 +22,12 @@ public:
     [[nodiscard]] std::filesystem::path GetInputFile() const { return input_file_; }
     [[nodiscard]] std::filesystem::path GetOutputFile() const { return output_file_; }
     [[nodiscard]] std::string GetPassword() const { return password_; }
+    [[nodiscard]] std::optional<std::string> GetMember() const { return member_; }
+    [[nodiscard]] size_t GetThreadsCount() const { return threads_count_; }
+    [[nodiscard]] bool IsCached() const { return cached_; }
+    [[nodiscard]] bool IsVerify() const { return verify_; }
+    [[nodiscard]] bool IsWatch() const { return watch_; }
+    [[nodiscard]] bool IsExisting() const { return existing_; }
     [[nodiscard]] bool IsHelp() const { return help_; }
     [[nodiscard]] std::string GetDescription() const;
 
@@ -29,6 +36,12 @@ private:
     static constexpr auto kOptionInput = "input";
     static constexpr auto kOptionOutput = "output";
     static constexpr auto kOptionPassword = "password";
+    static constexpr auto kOptionMember = "member";
+    static constexpr auto kOptionThreads = "threads";
+    static constexpr auto kOptionCached = "cached";
+    static constexpr auto kOptionVerify = "verify";
+    static constexpr auto kOptionWatch = "watch";
+    static constexpr auto kOptionExisting = "existing";
     static constexpr auto kOptionHelp = "help";
 
     ProgramOptions();
@@ -37,6 +50,12 @@ private:
     std::filesystem::path input_file_;
     std::filesystem::path output_file_;
     std::string password_;
+    std::optional<std::string> member_;
+    size_t threads_count_{};
+    bool cached_{};
+    bool verify_{};
+    bool watch_{};
+    bool existing_{};
     bool help_;
 
     boost::program_options::options_description desc_;
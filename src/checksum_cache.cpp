@@ -0,0 +1,169 @@
+#include "checksum_cache.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/xattr.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <streambuf>
+
+namespace crypto_guard {
+
+namespace {
+
+constexpr std::string_view kCacheVersion{"v1"};
+constexpr size_t kMaxXattrSize{256};
+
+// Reads exactly the opened file, even if its path is replaced in the meantime
+class FdStreamBuf : public std::streambuf {
+public:
+    explicit FdStreamBuf(int fd) : fd_{fd} {}
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+
+        ssize_t bytes_read{};
+        do {
+            bytes_read = pread(fd_, buf_.data(), buf_.size(), offset_);
+        } while (bytes_read < 0 && errno == EINTR);
+        if (bytes_read < 0) {
+            throw std::runtime_error(std::format("Couldn't read the file: {}", std::strerror(errno)));
+        }
+        if (bytes_read == 0) {
+            return traits_type::eof();
+        }
+        offset_ += bytes_read;
+
+        setg(buf_.data(), buf_.data(), buf_.data() + bytes_read);
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    static constexpr size_t kBufSize{16 * 1024};  // 16 KiB
+
+    int fd_;
+    off_t offset_{};
+    std::array<char, kBufSize> buf_{};
+};
+
+}  // namespace
+
+ChecksumCache::ChecksumCache(CryptoGuardCtx& crypto_ctx) : crypto_ctx_{crypto_ctx} {}
+
+std::string ChecksumCache::GetChecksum(const std::filesystem::path& file) {
+    const auto fd = OpenFile(file);
+    const auto metadata = GetFileMetadata(fd);
+    if (const auto cached = Load(fd); cached && cached->IsSameFile(metadata)) {
+        return cached->checksum;
+    }
+
+    const auto entry = Calculate(fd);
+    Update(fd, entry);
+    return entry.checksum;
+}
+
+std::expected<std::string, std::string> ChecksumCache::VerifyChecksum(const std::filesystem::path& file) {
+    const auto fd = OpenFile(file);
+    const auto cached = Load(fd);
+    const auto entry = Calculate(fd);
+
+    // The same metadata with another checksum means that the content was changed behind the file system's back,
+    // the cached value is kept so that the damage is reported until it's resolved
+    if (cached && cached->IsSameFile(entry) && cached->checksum != entry.checksum) {
+        return std::unexpected{std::format("checksum '{}' doesn't match the cached checksum '{}'", entry.checksum,
+                                           cached->checksum)};
+    }
+
+    Update(fd, entry);
+    return entry.checksum;
+}
+
+std::optional<ChecksumCacheEntry> ChecksumCache::Load(const std::filesystem::path& file) {
+    return Load(OpenFile(file));
+}
+
+bool ChecksumCache::Store(const std::filesystem::path& file, const ChecksumCacheEntry& entry) {
+    return Store(OpenFile(file), entry);
+}
+
+FileDescriptor ChecksumCache::OpenFile(const std::filesystem::path& file) {
+    FileDescriptor fd{open(file.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (fd.Get() < 0) {
+        throw std::runtime_error(std::format("Couldn't open the file '{}': {}", file.string(), std::strerror(errno)));
+    }
+    return fd;
+}
+
+std::optional<ChecksumCacheEntry> ChecksumCache::Load(const FileDescriptor& fd) {
+    std::array<char, kMaxXattrSize> value{};
+    const auto value_size = fgetxattr(fd.Get(), kXattrName, value.data(), value.size());
+    if (value_size < 0) {
+        return {};
+    }
+
+    std::istringstream value_stream{std::string{value.data(), static_cast<size_t>(value_size)}};
+    std::string version;
+    ChecksumCacheEntry entry{};
+    value_stream >> version >> entry.inode >> entry.size >> entry.mtime_ns >> entry.checksum;
+    if (!value_stream || version != kCacheVersion) {
+        return {};
+    }
+    return entry;
+}
+
+bool ChecksumCache::Store(const FileDescriptor& fd, const ChecksumCacheEntry& entry) {
+    // The cache is optional, so file systems without user xattrs or read-only files just aren't cached
+    const auto value =
+        std::format("{} {} {} {} {}", kCacheVersion, entry.inode, entry.size, entry.mtime_ns, entry.checksum);
+    return fsetxattr(fd.Get(), kXattrName, value.data(), value.size(), 0) == 0;
+}
+
+ChecksumCacheEntry ChecksumCache::GetFileMetadata(const FileDescriptor& fd) {
+    struct stat file_stat{};
+    if (fstat(fd.Get(), &file_stat) != 0) {
+        throw std::runtime_error(std::format("Couldn't get status of the file: {}", std::strerror(errno)));
+    }
+
+    ChecksumCacheEntry entry{};
+    entry.inode = file_stat.st_ino;
+    entry.size = file_stat.st_size;
+    entry.mtime_ns = static_cast<int64_t>(file_stat.st_mtim.tv_sec) * 1'000'000'000 + file_stat.st_mtim.tv_nsec;
+    return entry;
+}
+
+ChecksumCacheEntry ChecksumCache::Calculate(const FileDescriptor& fd) {
+    auto entry = GetFileMetadata(fd);
+    FdStreamBuf file_buf{fd.Get()};
+    std::istream in_stream{&file_buf};
+    in_stream.exceptions(std::ios::badbit);
+    entry.checksum = crypto_ctx_.CalculateChecksum(in_stream);
+    return entry;
+}
+
+void ChecksumCache::Update(const FileDescriptor& fd, const ChecksumCacheEntry& entry) {
+    // A file modified while its checksum was being calculated mustn't get a cache entry it doesn't match
+    if (!entry.IsSameFile(GetFileMetadata(fd))) {
+        return;
+    }
+
+    // A same-size rewrite within the same timestamp tick wouldn't change the metadata,
+    // so a checksum of a file modified that recently isn't trusted to stay valid
+    const auto now_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::system_clock::now().time_since_epoch())
+                            .count();
+    if (now_ns - entry.mtime_ns < kMtimeGranularityNs) {
+        return;
+    }
+
+    Store(fd, entry);
+}
+
+}  // namespace crypto_guard
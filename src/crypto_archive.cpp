@@ -0,0 +1,318 @@
+#include "crypto_archive.h"
+#include "crypto_guard_ctx.h"
+#include "file_utils.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+namespace crypto_guard {
+
+namespace {
+
+constexpr std::string_view kMagic{"CGARCHV1"};
+constexpr uint64_t kHeaderSize{kMagic.size() + 2 * sizeof(uint64_t)};  // magic, index offset, index size
+
+class BoundedStreamBuf : public std::streambuf {
+public:
+    BoundedStreamBuf(std::istream& source, uint64_t size) : source_{source}, remaining_{size} {}
+
+    [[nodiscard]] bool IsExhausted() const { return remaining_ == 0; }
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        if (remaining_ == 0) {
+            return traits_type::eof();
+        }
+
+        const auto to_read = std::min<uint64_t>(remaining_, buf_.size());
+        source_.read(buf_.data(), static_cast<std::streamsize>(to_read));
+        const auto bytes_read = source_.gcount();
+        if (bytes_read <= 0) {
+            return traits_type::eof();
+        }
+        remaining_ -= bytes_read;
+
+        setg(buf_.data(), buf_.data(), buf_.data() + bytes_read);
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    static constexpr size_t kBufSize{16 * 1024};  // 16 KiB
+
+    std::istream& source_;
+    uint64_t remaining_;
+    std::array<char, kBufSize> buf_{};
+};
+
+void WriteUint(std::ostream& out_stream, uint64_t value) {
+    std::array<char, sizeof(value)> bytes{};
+    for (auto& byte : bytes) {
+        byte = static_cast<char>(value & 0xFF);
+        value >>= 8;
+    }
+    out_stream.write(bytes.data(), bytes.size());
+}
+
+uint64_t ReadUint(std::istream& in_stream) {
+    std::array<char, sizeof(uint64_t)> bytes{};
+    in_stream.read(bytes.data(), bytes.size());
+    if (!in_stream) {
+        throw std::runtime_error("Archive is corrupted");
+    }
+    uint64_t value{};
+    for (auto it = bytes.rbegin(); it != bytes.rend(); ++it) {
+        value = (value << 8) | static_cast<uint8_t>(*it);
+    }
+    return value;
+}
+
+std::vector<std::filesystem::path> CollectFiles(const std::filesystem::path& input,
+                                                const std::filesystem::path& archive_path) {
+    std::vector<std::filesystem::path> files;
+    if (std::filesystem::is_regular_file(input)) {
+        files.push_back(input);
+        return files;
+    }
+    if (!std::filesystem::is_directory(input)) {
+        throw std::runtime_error(std::format("'{}' is neither a regular file nor a directory", input.string()));
+    }
+
+    // The archive may be created inside the packed directory, it mustn't get into itself
+    const auto archive_canonical = std::filesystem::weakly_canonical(archive_path);
+    for (const auto& dir_entry : std::filesystem::recursive_directory_iterator(input)) {
+        if (dir_entry.is_regular_file() &&
+            std::filesystem::weakly_canonical(dir_entry.path()) != archive_canonical) {
+            files.push_back(dir_entry.path());
+        }
+    }
+    std::ranges::sort(files);
+    return files;
+}
+
+std::string SerializeIndex(const std::vector<ArchiveEntry>& entries) {
+    std::stringstream index_stream;
+    WriteUint(index_stream, entries.size());
+    for (const auto& entry : entries) {
+        WriteUint(index_stream, entry.name.size());
+        index_stream.write(entry.name.data(), static_cast<std::streamsize>(entry.name.size()));
+        WriteUint(index_stream, entry.offset);
+        WriteUint(index_stream, entry.size);
+        WriteUint(index_stream, entry.original_size);
+    }
+    return index_stream.str();
+}
+
+std::vector<ArchiveEntry> DeserializeIndex(std::stringstream& index_stream) {
+    // Sizes are checked against the index length so that a corrupted index can't cause a huge allocation
+    const auto index_size = index_stream.view().size();
+    const auto entries_count = ReadUint(index_stream);
+    if (entries_count > index_size) {
+        throw std::runtime_error("Archive index is corrupted");
+    }
+
+    std::vector<ArchiveEntry> entries(entries_count);
+    for (auto& entry : entries) {
+        const auto name_size = ReadUint(index_stream);
+        if (name_size > index_size) {
+            throw std::runtime_error("Archive index is corrupted");
+        }
+        entry.name.resize(name_size);
+        index_stream.read(entry.name.data(), static_cast<std::streamsize>(entry.name.size()));
+        entry.offset = ReadUint(index_stream);
+        entry.size = ReadUint(index_stream);
+        entry.original_size = ReadUint(index_stream);
+    }
+    return entries;
+}
+
+bool IsSafeMemberName(const std::filesystem::path& name) {
+    if (name.empty() || name.is_absolute()) {
+        return false;
+    }
+    return std::ranges::none_of(name, [](const auto& part) { return part == ".."; });
+}
+
+}  // namespace
+
+void CryptoArchive::Pack(const std::filesystem::path& input, const std::filesystem::path& archive_path,
+                         std::string_view password, size_t threads_count) {
+    const auto files = CollectFiles(input, archive_path);
+    const auto is_dir = std::filesystem::is_directory(input);
+
+    // The encrypted size is known in advance, so every member gets its own region of the archive
+    // and can be written by any thread independently
+    std::vector<ArchiveEntry> entries;
+    entries.reserve(files.size());
+    uint64_t offset = kHeaderSize;
+    for (const auto& file : files) {
+        auto& entry = entries.emplace_back();
+        entry.name = (is_dir ? file.lexically_relative(input) : file.filename()).generic_string();
+        entry.offset = offset;
+        entry.original_size = std::filesystem::file_size(file);
+        entry.size = CryptoGuardCtx::GetEncryptedSize(entry.original_size);
+        offset += entry.size;
+    }
+
+    std::stringstream plain_index{SerializeIndex(entries)};
+    std::stringstream encrypted_index;
+    CryptoGuardCtx{}.EncryptFile(plain_index, encrypted_index, password);
+    const auto index = encrypted_index.view();
+
+    // A failed packing mustn't leave a corrupted archive behind
+    TempFile temp_archive{archive_path};
+    {
+        std::ofstream archive{temp_archive.GetPath(), std::ios::binary | std::ios::trunc};
+        if (!archive) {
+            throw std::runtime_error(std::format("Couldn't open the archive '{}'", temp_archive.GetPath().string()));
+        }
+        archive.write(kMagic.data(), kMagic.size());
+        WriteUint(archive, offset);
+        WriteUint(archive, index.size());
+        archive.seekp(static_cast<std::streamoff>(offset));
+        archive.write(index.data(), static_cast<std::streamsize>(index.size()));
+        if (!archive) {
+            throw std::runtime_error("Couldn't write to the archive");
+        }
+    }
+
+    std::atomic<size_t> next_entry{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    const auto pack_entries = [&] {
+        try {
+            CryptoGuardCtx ctx;
+            for (auto i = next_entry++; i < entries.size() && !failed; i = next_entry++) {
+                const auto& entry = entries[i];
+                std::ifstream member{files[i], std::ios::binary};
+                if (!member) {
+                    throw std::runtime_error(std::format("Couldn't open the file '{}'", files[i].string()));
+                }
+                std::ofstream archive{temp_archive.GetPath(), std::ios::binary | std::ios::in | std::ios::out};
+                if (!archive) {
+                    throw std::runtime_error(
+                        std::format("Couldn't open the archive '{}'", temp_archive.GetPath().string()));
+                }
+                archive.seekp(static_cast<std::streamoff>(entry.offset));
+
+                // The member is read no further than its size so that a grown file can't overwrite its neighbours
+                BoundedStreamBuf member_buf{member, entry.original_size};
+                std::istream bounded_member{&member_buf};
+                ctx.EncryptFile(bounded_member, archive, password);
+                if (!member_buf.IsExhausted() || member.peek() != std::ifstream::traits_type::eof()) {
+                    throw std::runtime_error(std::format("File '{}' was modified while packing", files[i].string()));
+                }
+            }
+        } catch (...) {
+            failed = true;
+            const std::lock_guard lock{error_mutex};
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        const auto workers_count = std::min(std::max<size_t>(threads_count, 1), entries.size());
+        for (size_t i = 0; i < workers_count; ++i) {
+            workers.emplace_back(pack_entries);
+        }
+    }
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    temp_archive.Commit();
+}
+
+std::vector<ArchiveEntry> CryptoArchive::ReadIndex(std::istream& archive, std::string_view password) {
+    if (!archive) {
+        throw std::runtime_error("Invalid archive stream");
+    }
+
+    archive.seekg(0);
+    std::array<char, kMagic.size()> magic{};
+    archive.read(magic.data(), magic.size());
+    if (!archive || std::string_view{magic.data(), magic.size()} != kMagic) {
+        throw std::runtime_error("Input is not a CryptoGuard archive");
+    }
+    const auto index_offset = ReadUint(archive);
+    const auto index_size = ReadUint(archive);
+
+    archive.seekg(static_cast<std::streamoff>(index_offset));
+    BoundedStreamBuf index_buf{archive, index_size};
+    std::istream encrypted_index{&index_buf};
+    std::stringstream plain_index;
+    CryptoGuardCtx{}.DecryptFile(encrypted_index, plain_index, password);
+    if (!index_buf.IsExhausted()) {
+        throw std::runtime_error("Archive is truncated");
+    }
+
+    return DeserializeIndex(plain_index);
+}
+
+void CryptoArchive::ExtractMember(std::istream& archive, const ArchiveEntry& entry, std::ostream& out_stream,
+                                 std::string_view password) {
+    archive.clear();
+    archive.seekg(static_cast<std::streamoff>(entry.offset));
+    if (!archive) {
+        throw std::runtime_error(std::format("Couldn't seek to the member '{}'", entry.name));
+    }
+
+    BoundedStreamBuf member_buf{archive, entry.size};
+    std::istream member{&member_buf};
+    CryptoGuardCtx{}.DecryptFile(member, out_stream, password);
+    if (!member_buf.IsExhausted()) {
+        throw std::runtime_error("Archive is truncated");
+    }
+}
+
+void CryptoArchive::Extract(const std::filesystem::path& archive_path, const std::filesystem::path& output_dir,
+                            std::string_view password, const std::optional<std::string>& member) {
+    std::ifstream archive{archive_path, std::ios::binary};
+    if (!archive) {
+        throw std::runtime_error(std::format("Couldn't open the archive '{}'", archive_path.string()));
+    }
+
+    auto entries = ReadIndex(archive, password);
+    if (member) {
+        std::erase_if(entries, [&member](const auto& entry) { return entry.name != *member; });
+        if (entries.empty()) {
+            throw std::runtime_error(std::format("Member '{}' not found in the archive", *member));
+        }
+    }
+
+    for (const auto& entry : entries) {
+        if (!IsSafeMemberName(entry.name)) {
+            throw std::runtime_error(std::format("Invalid member name '{}'", entry.name));
+        }
+        const auto output_file = output_dir / entry.name;
+        std::filesystem::create_directories(output_file.parent_path());
+        std::ofstream out_stream{output_file, std::ios::binary | std::ios::trunc};
+        if (!out_stream) {
+            throw std::runtime_error(std::format("Couldn't open the file '{}'", output_file.string()));
+        }
+        // A member that failed to extract mustn't be left truncated
+        try {
+            ExtractMember(archive, entry, out_stream, password);
+        } catch (...) {
+            out_stream.close();
+            std::error_code ec;
+            std::filesystem::remove(output_file, ec);
+            throw;
+        }
+    }
+}
+
+}  // namespace crypto_guard
@@ -1,10 +1,15 @@
 #include "crypto_guard_ctx.h"
 
+#include <openssl/crypto.h>
 #include <openssl/err.h>
 #include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <openssl/rand.h>
 
+#include <algorithm>
 #include <array>
 #include <iomanip>
+#include <optional>
 #include <sstream>
 
 namespace crypto_guard {
@@ -20,14 +25,77 @@ struct AesCipherParams {
     std::array<unsigned char, IV_SIZE> iv{};    // Initialization vector
 };
 
+struct EncryptedFileHeader {
+    static constexpr std::string_view MAGIC{"CGENCV01"};  // Format signature
+    static constexpr size_t SALT_SIZE = 8;                // EVP_BytesToKey salt size
+    static constexpr size_t KEY_CHECK_SIZE = 16;          // Truncated HMAC-SHA256 of the key
+    static constexpr size_t SIZE = MAGIC.size() + SALT_SIZE + KEY_CHECK_SIZE;
+
+    std::array<unsigned char, SALT_SIZE> salt{};            // Random salt for the key derivation
+    std::array<unsigned char, KEY_CHECK_SIZE> key_check{};  // Value to check the password with
+};
+
 class CryptoGuardCtx::Impl {
 public:
     void EncryptFile(std::istream& in_stream, std::ostream& out_stream, std::string_view password) {
-        ProcessFile(in_stream, out_stream, password, true);
+        CheckStreams(in_stream, out_stream);
+
+        EncryptedFileHeader header{};
+        if (!RAND_bytes(header.salt.data(), header.salt.size())) {
+            throw std::runtime_error(std::format("Couldn't generate salt: {}", GetErrReason()));
+        }
+        auto params = CreateCipherParamsFromPassword(password, header.salt);
+        params.encrypt = 1;
+        header.key_check = CalculateKeyCheck(params);
+
+        out_stream.write(EncryptedFileHeader::MAGIC.data(), EncryptedFileHeader::MAGIC.size());
+        out_stream.write(reinterpret_cast<const char*>(header.salt.data()), header.salt.size());
+        out_stream.write(reinterpret_cast<const char*>(header.key_check.data()), header.key_check.size());
+        if (!out_stream) {
+            throw std::runtime_error("Couldn't write to output stream");
+        }
+
+        ProcessFile(in_stream, out_stream, params);
     }
 
     void DecryptFile(std::istream& in_stream, std::ostream& out_stream, std::string_view password) {
-        ProcessFile(in_stream, out_stream, password, false);
+        CheckStreams(in_stream, out_stream);
+
+        std::array<char, EncryptedFileHeader::SIZE> header_buf{};
+        const auto header = ReadHeader(in_stream, header_buf);
+        if (!header) {
+            // Files encrypted before the header was introduced: the bytes already read are the ciphertext
+            auto params = CreateCipherParamsFromPassword(password, kLegacySalt);
+            params.encrypt = 0;
+            ProcessFile(in_stream, out_stream, params,
+                        std::string_view{header_buf.data(), static_cast<size_t>(in_stream.gcount())});
+            return;
+        }
+
+        // The password is checked before any payload is processed, so the output is left untouched
+        auto params = CreateCheckedCipherParams(password, *header);
+        params.encrypt = 0;
+        ProcessFile(in_stream, out_stream, params);
+    }
+
+    void CheckPassword(std::istream& in_stream, std::string_view password) {
+        if (in_stream.fail() && !in_stream.eof()) {
+            throw std::runtime_error{"Invalid input stream"};
+        }
+
+        const auto start_pos = in_stream.tellg();
+        std::array<char, EncryptedFileHeader::SIZE> header_buf{};
+        const auto header = ReadHeader(in_stream, header_buf);
+        in_stream.clear();
+        in_stream.seekg(start_pos);
+        if (!in_stream) {
+            throw std::runtime_error("Couldn't rewind input stream");
+        }
+
+        // Files without the header have nothing to check the password with
+        if (header) {
+            static_cast<void>(CreateCheckedCipherParams(password, *header));
+        }
     }
 
     [[nodiscard]] std::string CalculateChecksum(std::istream& in_stream) {
@@ -74,13 +142,17 @@ private:
     using EvpCipherCtxPtr = std::unique_ptr<EVP_CIPHER_CTX, EvpCipherCtxDeleter>;
     using EvpMdCtxPtr = std::unique_ptr<EVP_MD_CTX, EvpMdCtxDeleter>;
 
-    static constexpr std::string_view kSalt{"12345678"};
+    using Salt = decltype(EncryptedFileHeader::salt);
+    using KeyCheck = decltype(EncryptedFileHeader::key_check);
+
+    static constexpr Salt kLegacySalt{'1', '2', '3', '4', '5', '6', '7', '8'};
+    static constexpr std::string_view kKeyCheckLabel{"CryptoGuard key check"};
     static constexpr size_t kBufSize{16 * 1024};  // 16 KiB
 
-    static AesCipherParams CreateCipherParamsFromPassword(std::string_view password) {
+    static AesCipherParams CreateCipherParamsFromPassword(std::string_view password, const Salt& salt) {
         AesCipherParams params{};
 
-        int result = EVP_BytesToKey(params.cipher, EVP_sha256(), reinterpret_cast<const unsigned char*>(kSalt.data()),
+        int result = EVP_BytesToKey(params.cipher, EVP_sha256(), salt.data(),
                                     reinterpret_cast<const unsigned char*>(password.data()),
                                     static_cast<int>(password.size()), 1, params.key.data(), params.iv.data());
 
@@ -91,15 +163,53 @@ private:
         return params;
     }
 
-    static EvpCipherCtxPtr CreateCipherCtx(std::string_view password, bool encrypt) {
+    static KeyCheck CalculateKeyCheck(const AesCipherParams& params) {
+        std::array<unsigned char, EVP_MAX_MD_SIZE> mac{};
+        uint32_t mac_len{};
+        if (!HMAC(EVP_sha256(), params.key.data(), static_cast<int>(params.key.size()),
+                  reinterpret_cast<const unsigned char*>(kKeyCheckLabel.data()), kKeyCheckLabel.size(), mac.data(),
+                  &mac_len)) {
+            throw std::runtime_error(std::format("Couldn't calculate key check value: {}", GetErrReason()));
+        }
+
+        KeyCheck key_check{};
+        std::copy_n(mac.begin(), key_check.size(), key_check.begin());
+        return key_check;
+    }
+
+    static std::optional<EncryptedFileHeader> ReadHeader(std::istream& in_stream,
+                                                         std::array<char, EncryptedFileHeader::SIZE>& header_buf) {
+        in_stream.read(header_buf.data(), header_buf.size());
+        if (in_stream.fail() && !in_stream.eof()) {
+            throw std::runtime_error("Couldn't read from input stream");
+        }
+        const std::string_view header_view{header_buf.data(), static_cast<size_t>(in_stream.gcount())};
+        if (header_view.size() < EncryptedFileHeader::SIZE || !header_view.starts_with(EncryptedFileHeader::MAGIC)) {
+            return {};
+        }
+
+        EncryptedFileHeader header{};
+        auto header_it = header_buf.begin() + EncryptedFileHeader::MAGIC.size();
+        header_it = std::ranges::copy_n(header_it, header.salt.size(), header.salt.begin()).in;
+        std::ranges::copy_n(header_it, header.key_check.size(), header.key_check.begin());
+        return header;
+    }
+
+    static AesCipherParams CreateCheckedCipherParams(std::string_view password, const EncryptedFileHeader& header) {
+        auto params = CreateCipherParamsFromPassword(password, header.salt);
+        const auto key_check = CalculateKeyCheck(params);
+        if (CRYPTO_memcmp(key_check.data(), header.key_check.data(), key_check.size()) != 0) {
+            throw std::runtime_error("Invalid password");
+        }
+        return params;
+    }
+
+    static EvpCipherCtxPtr CreateCipherCtx(const AesCipherParams& params) {
         auto ctx = EvpCipherCtxPtr{EVP_CIPHER_CTX_new()};
         if (!ctx) {
             throw std::runtime_error(std::format("Couldn't create cipher context: {}", GetErrReason()));
         }
 
-        auto params = CreateCipherParamsFromPassword(password);
-        params.encrypt = encrypt ? 1 : 0;
-
         if (!EVP_CipherInit_ex(ctx.get(), params.cipher, nullptr, params.key.data(), params.iv.data(),
                                params.encrypt)) {
             throw std::runtime_error(std::format("Couldn't initialize cipher context: {}", GetErrReason()));
@@ -128,15 +238,33 @@ private:
         return ctx;
     }
 
-    void ProcessFile(std::istream& in_stream, std::ostream& out_stream, std::string_view password, bool encrypt) {
+    static void CheckStreams(const std::istream& in_stream, const std::ostream& out_stream) {
         if (in_stream.fail() && !in_stream.eof()) {
             throw std::runtime_error{"Invalid input stream"};
         }
         if (!out_stream) {
             throw std::runtime_error{"Invalid output stream"};
         }
+    }
 
-        const auto ctx = CreateCipherCtx(password, encrypt);
+    void ProcessFile(std::istream& in_stream, std::ostream& out_stream, const AesCipherParams& params,
+                     std::string_view prefix = {}) {
+        const auto ctx = CreateCipherCtx(params);
+        const bool encrypt = params.encrypt;
+
+        if (!prefix.empty()) {
+            int out_len{};
+            if (!EVP_CipherUpdate(ctx.get(), reinterpret_cast<unsigned char*>(out_buf_.data()), &out_len,
+                                  reinterpret_cast<const unsigned char*>(prefix.data()),
+                                  static_cast<int>(prefix.size()))) {
+                throw std::runtime_error(
+                    std::format("Couldn't {} data: {}", encrypt ? "encrypt" : "decrypt", GetErrReason()));
+            }
+            out_stream.write(out_buf_.data(), out_len);
+            if (!out_stream) {
+                throw std::runtime_error("Couldn't write to output stream");
+            }
+        }
 
         while (!in_stream.eof()) {
             in_stream.read(in_buf_.data(), in_buf_.size());
@@ -184,6 +312,16 @@ void CryptoGuardCtx::DecryptFile(std::istream& in_stream, std::ostream& out_stre
     impl_->DecryptFile(in_stream, out_stream, password);
 }
 
+void CryptoGuardCtx::CheckPassword(std::istream& in_stream, std::string_view password) {
+    impl_->CheckPassword(in_stream, password);
+}
+
 std::string CryptoGuardCtx::CalculateChecksum(std::istream& in_stream) { return impl_->CalculateChecksum(in_stream); }
 
+uint64_t CryptoGuardCtx::GetEncryptedSize(uint64_t plain_size) {
+    // PKCS#7 padding always adds from 1 to a whole block of bytes
+    constexpr auto block_size = AesCipherParams::IV_SIZE;
+    return EncryptedFileHeader::SIZE + (plain_size / block_size + 1) * block_size;
+}
+
 }  // namespace crypto_guard
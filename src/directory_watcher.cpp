@@ -0,0 +1,259 @@
+#include "directory_watcher.h"
+#include "file_utils.h"
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace crypto_guard {
+
+namespace {
+
+std::string GetErrnoReason() { return std::strerror(errno); }
+
+}  // namespace
+
+class DirectoryWatcher::Impl {
+public:
+    Impl(std::filesystem::path dir, size_t workers_count, bool handle_existing_files, FileHandler file_handler,
+         ErrorHandler error_handler)
+        : dir_{std::move(dir)},
+          workers_count_{std::max<size_t>(workers_count, 1)},
+          queue_capacity_{workers_count_ * kQueueSizePerWorker},
+          file_handler_{std::move(file_handler)},
+          error_handler_{std::move(error_handler)},
+          inotify_fd_{inotify_init1(IN_NONBLOCK | IN_CLOEXEC)},
+          stop_fd_{eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)} {
+        if (inotify_fd_.Get() < 0) {
+            throw std::runtime_error(std::format("Couldn't initialize inotify: {}", GetErrnoReason()));
+        }
+        if (stop_fd_.Get() < 0) {
+            throw std::runtime_error(std::format("Couldn't create eventfd: {}", GetErrnoReason()));
+        }
+        // Only finalized files are handled: closed after writing or moved into the directory
+        if (inotify_add_watch(inotify_fd_.Get(), dir_.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_ONLYDIR) < 0) {
+            throw std::runtime_error(
+                std::format("Couldn't watch the directory '{}': {}", dir_.string(), GetErrnoReason()));
+        }
+        // Listed after the watch is added, so no file is missed between the listing and the first event
+        if (handle_existing_files) {
+            existing_files_ = ListFiles();
+        }
+    }
+
+    void Run() {
+        std::vector<std::jthread> workers;
+        for (size_t i = 0; i < workers_count_; ++i) {
+            workers.emplace_back([this] { HandleFiles(); });
+        }
+
+        try {
+            for (const auto& file : std::exchange(existing_files_, {})) {
+                EnqueueIfRegularFile(file);
+            }
+            WatchEvents();
+        } catch (...) {
+            StopWorkers();
+            throw;
+        }
+        StopWorkers();
+    }
+
+    void Stop() {
+        const uint64_t value = 1;
+        [[maybe_unused]] const auto written = write(stop_fd_.Get(), &value, sizeof(value));
+    }
+
+    size_t GetQueuedFilesCount() const {
+        const std::lock_guard lock{mutex_};
+        return queue_.size();
+    }
+
+private:
+    enum class FileState { queued, handling, changed_while_handling };
+
+    static constexpr size_t kQueueSizePerWorker{64};
+    static constexpr size_t kEventsBufSize{64 * 1024};  // 64 KiB
+
+    void WatchEvents() {
+        std::array<pollfd, 2> fds{{
+            {.fd = inotify_fd_.Get(), .events = POLLIN, .revents = 0},
+            {.fd = stop_fd_.Get(), .events = POLLIN, .revents = 0},
+        }};
+
+        while (true) {
+            if (poll(fds.data(), fds.size(), -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::format("Couldn't wait for inotify events: {}", GetErrnoReason()));
+            }
+
+            // Events that occurred before the stop are still handled
+            if (fds[0].revents & POLLIN) {
+                ReadEvents();
+            }
+            if (fds[1].revents & POLLIN) {
+                return;
+            }
+        }
+    }
+
+    void ReadEvents() {
+        alignas(inotify_event) std::array<char, kEventsBufSize> events_buf{};
+        while (true) {
+            const auto bytes_read = read(inotify_fd_.Get(), events_buf.data(), events_buf.size());
+            if (bytes_read < 0) {
+                if (errno == EAGAIN) {
+                    return;
+                }
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::runtime_error(std::format("Couldn't read inotify events: {}", GetErrnoReason()));
+            }
+
+            for (auto event_it = events_buf.data(); event_it < events_buf.data() + bytes_read;) {
+                const auto* event = reinterpret_cast<const inotify_event*>(event_it);
+                event_it += sizeof(inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    // Some events are lost, so the whole directory has to be rescanned
+                    EnqueueDirectory();
+                } else if (event->mask & IN_IGNORED) {
+                    throw std::runtime_error(std::format("Watched directory '{}' was removed", dir_.string()));
+                } else if (!(event->mask & IN_ISDIR) && event->len > 0) {
+                    EnqueueIfRegularFile(dir_ / event->name);
+                }
+            }
+        }
+    }
+
+    std::vector<std::filesystem::path> ListFiles() const {
+        std::vector<std::filesystem::path> files;
+        for (const auto& dir_entry : std::filesystem::directory_iterator(dir_)) {
+            if (dir_entry.is_regular_file()) {
+                files.push_back(dir_entry.path());
+            }
+        }
+        return files;
+    }
+
+    void EnqueueDirectory() {
+        for (const auto& file : ListFiles()) {
+            Enqueue(file);
+        }
+    }
+
+    // Sockets, FIFOs and files removed since the event aren't handled
+    void EnqueueIfRegularFile(const std::filesystem::path& file) {
+        std::error_code ec;
+        if (std::filesystem::is_regular_file(file, ec)) {
+            Enqueue(file);
+        }
+    }
+
+    void Enqueue(const std::filesystem::path& file) {
+        std::unique_lock lock{mutex_};
+
+        // Repeated events are coalesced: a queued file is handled once, a file being handled is handled once more
+        if (const auto it = files_states_.find(file.native()); it != files_states_.end()) {
+            if (it->second == FileState::handling) {
+                it->second = FileState::changed_while_handling;
+            }
+            return;
+        }
+
+        queue_not_full_.wait(lock, [this] { return queue_.size() < queue_capacity_; });
+        files_states_.emplace(file.native(), FileState::queued);
+        queue_.push_back(file);
+        lock.unlock();
+        queue_not_empty_.notify_one();
+    }
+
+    void HandleFiles() {
+        CryptoGuardCtx crypto_ctx;
+        while (true) {
+            std::filesystem::path file;
+            {
+                std::unique_lock lock{mutex_};
+                queue_not_empty_.wait(lock, [this] { return !queue_.empty() || stopping_; });
+                if (queue_.empty()) {
+                    return;
+                }
+                file = std::move(queue_.front());
+                queue_.pop_front();
+                files_states_[file.native()] = FileState::handling;
+            }
+            queue_not_full_.notify_one();
+
+            try {
+                file_handler_(crypto_ctx, file);
+            } catch (const std::exception& e) {
+                error_handler_(file, e);
+            }
+
+            std::unique_lock lock{mutex_};
+            const auto it = files_states_.find(file.native());
+            if (it->second == FileState::changed_while_handling) {
+                it->second = FileState::queued;
+                queue_.push_back(std::move(file));
+                lock.unlock();
+                queue_not_empty_.notify_one();
+            } else {
+                files_states_.erase(it);
+            }
+        }
+    }
+
+    void StopWorkers() {
+        {
+            const std::lock_guard lock{mutex_};
+            stopping_ = true;
+        }
+        queue_not_empty_.notify_all();
+    }
+
+    std::filesystem::path dir_;
+    size_t workers_count_;
+    size_t queue_capacity_;
+    FileHandler file_handler_;
+    ErrorHandler error_handler_;
+    FileDescriptor inotify_fd_;
+    FileDescriptor stop_fd_;
+    std::vector<std::filesystem::path> existing_files_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable queue_not_empty_;
+    std::condition_variable queue_not_full_;
+    std::deque<std::filesystem::path> queue_;
+    std::unordered_map<std::string, FileState> files_states_;
+    bool stopping_{};
+};
+
+DirectoryWatcher::DirectoryWatcher(std::filesystem::path dir, size_t workers_count, bool handle_existing_files,
+                                   FileHandler file_handler, ErrorHandler error_handler)
+    : impl_{std::make_unique<Impl>(std::move(dir), workers_count, handle_existing_files, std::move(file_handler),
+                                   std::move(error_handler))} {}
+
+DirectoryWatcher::~DirectoryWatcher() = default;
+
+void DirectoryWatcher::Run() { impl_->Run(); }
+
+void DirectoryWatcher::Stop() { impl_->Stop(); }
+
+size_t DirectoryWatcher::GetQueuedFilesCount() const { return impl_->GetQueuedFilesCount(); }
+
+}  // namespace crypto_guard
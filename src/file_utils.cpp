@@ -0,0 +1,46 @@
+#include "file_utils.h"
+
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <string>
+
+namespace crypto_guard {
+
+FileDescriptor::~FileDescriptor() {
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+TempFile::TempFile(std::filesystem::path target) : target_{std::move(target)} {
+    auto path_template = target_.string();
+    path_template += ".XXXXXX";
+    path_template += kSuffix;
+
+    const auto fd = mkstemps(path_template.data(), static_cast<int>(kSuffix.size()));
+    if (fd < 0) {
+        throw std::runtime_error(
+            std::format("Couldn't create a temporary file for '{}': {}", target_.string(), std::strerror(errno)));
+    }
+    close(fd);
+    path_ = path_template;
+}
+
+TempFile::~TempFile() {
+    if (!committed_) {
+        std::error_code ec;
+        std::filesystem::remove(path_, ec);
+    }
+}
+
+void TempFile::Commit() {
+    std::filesystem::rename(path_, target_);
+    committed_ = true;
+}
+
+}  // namespace crypto_guard
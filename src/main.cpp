@@ -1,11 +1,97 @@
+#include "checksum_cache.h"
+#include "crypto_archive.h"
 #include "crypto_guard_ctx.h"
+#include "directory_watcher.h"
+#include "file_utils.h"
 #include "program_options.h"
 
+#include <atomic>
+#include <csignal>
 #include <fstream>
 #include <print>
 #include <stdexcept>
 #include <string>
 
+namespace {
+
+std::atomic<crypto_guard::DirectoryWatcher*> running_watcher{};
+
+void StopRunningWatcher(int /*signal*/) {
+    if (auto* watcher = running_watcher.load()) {
+        watcher->Stop();
+    }
+}
+
+void EncryptWatchedFile(crypto_guard::CryptoGuardCtx& crypto_ctx, const std::filesystem::path& file,
+                        const crypto_guard::ProgramOptions& options) {
+    std::ifstream src_file{file};
+    if (!src_file) {
+        throw std::runtime_error(std::format("Could not open the input file '{}'", file.string()));
+    }
+
+    // The encrypted file appears in the output directory only when it's complete
+    const auto encrypted_file_path = options.GetOutputFile() / file.filename();
+    crypto_guard::TempFile temp_encrypted_file{encrypted_file_path};
+    {
+        std::ofstream encrypted_file{temp_encrypted_file.GetPath()};
+        if (!encrypted_file) {
+            throw std::runtime_error(
+                std::format("Could not open the output file '{}'", temp_encrypted_file.GetPath().string()));
+        }
+        crypto_ctx.EncryptFile(src_file, encrypted_file, options.GetPassword());
+    }
+    temp_encrypted_file.Commit();
+    std::println("File '{}' encrypted successfully to the '{}'", file.string(), encrypted_file_path.string());
+}
+
+void ChecksumWatchedFile(crypto_guard::CryptoGuardCtx& crypto_ctx, const std::filesystem::path& file) {
+    std::ifstream in_file{file};
+    if (!in_file) {
+        throw std::runtime_error(std::format("Could not open the input file '{}'", file.string()));
+    }
+    std::println("File '{}' checksum: {}", file.string(), crypto_ctx.CalculateChecksum(in_file));
+}
+
+void Watch(const crypto_guard::ProgramOptions& options) {
+    const auto encrypt = options.GetCommand() == crypto_guard::ProgramOptions::CommandType::encrypt;
+    if (encrypt) {
+        // Encrypted files written into the watched directory would be encrypted again endlessly
+        if (std::filesystem::weakly_canonical(options.GetInputFile()) ==
+            std::filesystem::weakly_canonical(options.GetOutputFile())) {
+            throw std::runtime_error(std::format("The output directory '{}' must differ from the watched one",
+                                                 options.GetOutputFile().string()));
+        }
+        std::filesystem::create_directories(options.GetOutputFile());
+    }
+
+    crypto_guard::DirectoryWatcher watcher{
+        options.GetInputFile(), options.GetThreadsCount(), options.IsExisting(),
+        [&options, encrypt](crypto_guard::CryptoGuardCtx& crypto_ctx, const std::filesystem::path& file) {
+            if (encrypt) {
+                EncryptWatchedFile(crypto_ctx, file, options);
+            } else {
+                ChecksumWatchedFile(crypto_ctx, file);
+            }
+        },
+        [](const std::filesystem::path& file, const std::exception& error) {
+            std::println("Could not process the file '{}': {}", file.string(), error.what());
+        }};
+
+    running_watcher = &watcher;
+    std::signal(SIGINT, StopRunningWatcher);
+    std::signal(SIGTERM, StopRunningWatcher);
+    std::println("Watching the directory '{}', press Ctrl+C to stop", options.GetInputFile().string());
+    try {
+        watcher.Run();
+    } catch (...) {
+        running_watcher = nullptr;
+        throw;
+    }
+    running_watcher = nullptr;
+}
+
+}  // namespace
+
 int main(int argc, char* argv[]) {
     try {
         const auto parsing_result = crypto_guard::ProgramOptions::Parse(std::span(argv, argc));
@@ -18,6 +104,10 @@ int main(int argc, char* argv[]) {
             std::println("{}", options.GetDescription());
             return 0;
         }
+        if (options.IsWatch()) {
+            Watch(options);
+            return 0;
+        }
 
         crypto_guard::CryptoGuardCtx crypto_ctx;
         using COMMAND_TYPE = crypto_guard::ProgramOptions::CommandType;
@@ -44,6 +134,8 @@ int main(int argc, char* argv[]) {
                 std::println("Could not open the input file '{}'", options.GetInputFile().string());
                 return 1;
             }
+            // The output file is opened only when the password is right, so a wrong one leaves it untouched
+            crypto_ctx.CheckPassword(encrypted_file, options.GetPassword());
             std::ofstream decrypted_file{options.GetOutputFile()};
             if (!decrypted_file) {
                 std::println("Could not open the output file '{}'", options.GetOutputFile().string());
@@ -55,6 +147,22 @@ int main(int argc, char* argv[]) {
             break;
         }
         case COMMAND_TYPE::checksum: {
+            if (options.IsCached()) {
+                crypto_guard::ChecksumCache checksum_cache{crypto_ctx};
+                std::println("Checksum: {}", checksum_cache.GetChecksum(options.GetInputFile()));
+                break;
+            }
+            if (options.IsVerify()) {
+                crypto_guard::ChecksumCache checksum_cache{crypto_ctx};
+                const auto verification_result = checksum_cache.VerifyChecksum(options.GetInputFile());
+                if (!verification_result) {
+                    std::println("Verification of the file '{}' failed: {}", options.GetInputFile().string(),
+                                 verification_result.error());
+                    return 1;
+                }
+                std::println("Checksum: {}", verification_result.value());
+                break;
+            }
             std::ifstream file{options.GetInputFile()};
             if (!file) {
                 std::println("Could not open the input file '{}'", options.GetInputFile().string());
@@ -63,6 +171,20 @@ int main(int argc, char* argv[]) {
             std::println("Checksum: {}", crypto_ctx.CalculateChecksum(file));
             break;
         }
+        case COMMAND_TYPE::archive: {
+            crypto_guard::CryptoArchive::Pack(options.GetInputFile(), options.GetOutputFile(), options.GetPassword(),
+                                              options.GetThreadsCount());
+            std::println("'{}' archived successfully to the '{}'", options.GetInputFile().string(),
+                         options.GetOutputFile().string());
+            break;
+        }
+        case COMMAND_TYPE::extract: {
+            crypto_guard::CryptoArchive::Extract(options.GetInputFile(), options.GetOutputFile(),
+                                                 options.GetPassword(), options.GetMember());
+            std::println("Archive '{}' extracted successfully to the '{}'", options.GetInputFile().string(),
+                         options.GetOutputFile().string());
+            break;
+        }
         default: {
             throw std::runtime_error{"Unsupported command"};
         }
@@ -3,6 +3,7 @@
 #include <expected>
 #include <filesystem>
 #include <iostream>
+#include <thread>
 
 namespace po = boost::program_options;
 
@@ -16,10 +17,16 @@ ProgramOptions::ProgramOptions() : desc_("Allowed options") {
     // clang-format off
     desc_.add_options()
         (MakeOptionName(kOptionHelp, "h").c_str(), po::bool_switch(&help_), "help")
-        (MakeOptionName(kOptionCommand, "c").c_str(), po::value<CommandType>(&command_), "type of command being executed, available values: encrypt, decrypt, checksum")
-        (MakeOptionName(kOptionInput, "i").c_str(), po::value<std::filesystem::path>(&input_file_), "path to the input file")
-        (MakeOptionName(kOptionOutput, "o").c_str(), po::value<std::filesystem::path>(&output_file_), "path to the file where the result will be saved")
+        (MakeOptionName(kOptionCommand, "c").c_str(), po::value<CommandType>(&command_), "type of command being executed, available values: encrypt, decrypt, checksum, archive, extract")
+        (MakeOptionName(kOptionInput, "i").c_str(), po::value<std::filesystem::path>(&input_file_), "path to the input file (or directory for archive)")
+        (MakeOptionName(kOptionOutput, "o").c_str(), po::value<std::filesystem::path>(&output_file_), "path to the file where the result will be saved (or directory for extract)")
         (MakeOptionName(kOptionPassword, "p").c_str(), po::value<std::string>(&password_)->default_value(""), "password for encryption and decryption")
+        (MakeOptionName(kOptionMember, "m").c_str(), po::value<std::string>(), "name of the single archive member to extract")
+        (kOptionCached, po::bool_switch(&cached_), "use the checksum cached in the file extended attributes if the file wasn't changed")
+        (kOptionVerify, po::bool_switch(&verify_), "recalculate the checksum bypassing the cache and compare it with the cached one")
+        (MakeOptionName(kOptionWatch, "w").c_str(), po::bool_switch(&watch_), "watch the input directory and encrypt or checksum files as soon as they are written into it")
+        (kOptionExisting, po::bool_switch(&existing_), "also handle the files that are already in the watched directory")
+        (MakeOptionName(kOptionThreads, "t").c_str(), po::value<size_t>(&threads_count_)->default_value(std::thread::hardware_concurrency()), "number of threads used for archiving and watching")
     ;
     // clang-format on
 }
@@ -41,10 +48,42 @@ std::expected<ProgramOptions, std::string> ProgramOptions::Parse(std::span<const
             throw po::required_option(kOptionCommand);
         }
 
+        if (vm.contains(kOptionMember)) {
+            if (options.command_ != CommandType::extract) {
+                return std::unexpected{
+                    std::format("option '--{}' is available only for extract command", kOptionMember)};
+            }
+            options.member_ = vm[kOptionMember].as<std::string>();
+        }
+
+        if (!vm[kOptionThreads].defaulted() && options.command_ != CommandType::archive && !options.watch_) {
+            return std::unexpected{
+                std::format("option '--{}' is available only for archive command and watch mode", kOptionThreads)};
+        }
+
+        if ((options.cached_ || options.verify_) && options.command_ != CommandType::checksum) {
+            return std::unexpected{std::format("options '--{}' and '--{}' are available only for checksum command",
+                                               kOptionCached, kOptionVerify)};
+        }
+
+        if (options.watch_ && options.command_ != CommandType::encrypt && options.command_ != CommandType::checksum) {
+            return std::unexpected{std::format("option '--{}' is available only for encrypt and checksum commands",
+                                               kOptionWatch)};
+        }
+
+        if (options.existing_ && !options.watch_) {
+            return std::unexpected{std::format("option '--{}' is available only with '--{}'", kOptionExisting,
+                                               kOptionWatch)};
+        }
+
         switch (options.command_) {
         case CommandType::encrypt:
             [[fallthrough]];
-        case CommandType::decrypt: {
+        case CommandType::decrypt:
+            [[fallthrough]];
+        case CommandType::archive:
+            [[fallthrough]];
+        case CommandType::extract: {
             if (not vm.contains(kOptionInput)) {
                 throw po::required_option(kOptionInput);
             }
@@ -63,6 +102,18 @@ std::expected<ProgramOptions, std::string> ProgramOptions::Parse(std::span<const
             if (not vm.contains(kOptionInput)) {
                 throw po::required_option(kOptionInput);
             }
+
+            if (options.cached_ && options.verify_) {
+                return std::unexpected{std::format("options '--{}' and '--{}' are mutually exclusive", kOptionCached,
+                                                   kOptionVerify)};
+            }
+
+            // Watched files are handled right after they're written, and checksums of just modified files
+            // are never cached
+            if ((options.cached_ || options.verify_) && options.watch_) {
+                return std::unexpected{std::format("options '--{}' and '--{}' can't be used with '--{}'",
+                                                   kOptionCached, kOptionVerify, kOptionWatch)};
+            }
             break;
         }
         case CommandType::LAST: {
@@ -90,6 +141,8 @@ std::optional<ProgramOptions::CommandType> ProgramOptions::ParseCommandType(std:
         {"encrypt", CommandType::encrypt},
         {"decrypt", CommandType::decrypt},
         {"checksum", CommandType::checksum},
+        {"archive", CommandType::archive},
+        {"extract", CommandType::extract},
     };
     assert(type_map.size() == static_cast<int>(CommandType::LAST));
 
@@ -108,6 +161,10 @@ std::string CommandTypeToString(ProgramOptions::CommandType type) {
         return "decrypt";
     case ProgramOptions::CommandType::checksum:
         return "checksum";
+    case ProgramOptions::CommandType::archive:
+        return "archive";
+    case ProgramOptions::CommandType::extract:
+        return "extract";
     case ProgramOptions::CommandType::LAST:
     default:
         assert(false);
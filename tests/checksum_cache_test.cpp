@@ -0,0 +1,90 @@
+#include "checksum_cache.h"
+#include "temp_dir_test.h"
+
+#include <sys/xattr.h>
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+namespace crypto_guard::test {
+
+class ChecksumCacheTest : public TempDirTest {
+public:
+    static constexpr auto kContent = "Test string";
+    static constexpr auto kContentChecksum = "a3e49d843df13c2e2a7786f6ecd7e0d184f45d718d1ac1a8a63e570466e489dd";
+    static constexpr auto kFakeChecksum = "0000000000000000000000000000000000000000000000000000000000000000";
+    static constexpr auto kProbeXattrName = "user.crypto_guard.test";
+
+    void SetUp() override {
+        TempDirTest::SetUp();
+        file_ = root_dir_ / "file";
+        WriteFile(file_, kContent);
+        // Checksums of files modified just now aren't cached
+        std::filesystem::last_write_time(file_,
+                                         std::filesystem::file_time_type::clock::now() - std::chrono::hours{1});
+        if (setxattr(file_.c_str(), kProbeXattrName, "", 0, 0) != 0) {
+            GTEST_SKIP() << "User extended attributes aren't supported by the file system";
+        }
+    }
+
+    void StoreFakeChecksum() const {
+        auto entry = ChecksumCache::Load(file_);
+        ASSERT_TRUE(entry.has_value());
+        entry->checksum = kFakeChecksum;
+        ASSERT_TRUE(ChecksumCache::Store(file_, *entry));
+    }
+
+    CryptoGuardCtx ctx_;
+    ChecksumCache cache_{ctx_};
+    std::filesystem::path file_;
+};
+
+TEST_F(ChecksumCacheTest, calculate_and_store_checksum) {
+    ASSERT_EQ(cache_.GetChecksum(file_), kContentChecksum);
+    const auto entry = ChecksumCache::Load(file_);
+    ASSERT_TRUE(entry.has_value());
+    ASSERT_EQ(entry->checksum, kContentChecksum);
+    ASSERT_EQ(entry->size, std::string_view{kContent}.size());
+}
+
+TEST_F(ChecksumCacheTest, return_cached_checksum_of_unchanged_file) {
+    ASSERT_EQ(cache_.GetChecksum(file_), kContentChecksum);
+    StoreFakeChecksum();
+    ASSERT_EQ(cache_.GetChecksum(file_), kFakeChecksum);
+}
+
+TEST_F(ChecksumCacheTest, recalculate_checksum_of_changed_file) {
+    ASSERT_EQ(cache_.GetChecksum(file_), kContentChecksum);
+    WriteFile(file_, "");
+    constexpr auto empty_checksum = "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855";
+    ASSERT_EQ(cache_.GetChecksum(file_), empty_checksum);
+}
+
+TEST_F(ChecksumCacheTest, dont_store_checksum_of_just_modified_file) {
+    WriteFile(file_, kContent);
+    ASSERT_EQ(cache_.GetChecksum(file_), kContentChecksum);
+    ASSERT_FALSE(ChecksumCache::Load(file_).has_value());
+}
+
+TEST_F(ChecksumCacheTest, verify_checksum_without_cache) {
+    const auto result = cache_.VerifyChecksum(file_);
+    ASSERT_TRUE(result.has_value());
+    ASSERT_EQ(result.value(), kContentChecksum);
+    ASSERT_EQ(ChecksumCache::Load(file_)->checksum, kContentChecksum);
+}
+
+TEST_F(ChecksumCacheTest, verify_checksum_bypasses_cache) {
+    ASSERT_EQ(cache_.GetChecksum(file_), kContentChecksum);
+    StoreFakeChecksum();
+    const auto result = cache_.VerifyChecksum(file_);
+    ASSERT_FALSE(result.has_value());
+    ASSERT_TRUE(result.error().find(kContentChecksum) != std::string::npos);
+    ASSERT_EQ(ChecksumCache::Load(file_)->checksum, kFakeChecksum);
+}
+
+TEST_F(ChecksumCacheTest, try_to_get_checksum_of_missing_file) {
+    ASSERT_THROW(static_cast<void>(cache_.GetChecksum(file_.string() + "_missing")), std::runtime_error);
+}
+
+}  // namespace crypto_guard::test
@@ -1,5 +1,6 @@
 #include "crypto_guard_ctx.h"
 
+#include <array>
 #include <fstream>
 
 #include <gtest/gtest.h>
@@ -16,6 +17,14 @@ public:
         return ss;
     }
 
+    // "Test string" encrypted with the password "pass" before the header was introduced
+    static std::string LegacyEncryptedFileContent() {
+        constexpr std::array<unsigned char, 16> content{
+            0x24, 0xda, 0xc2, 0x65, 0x0f, 0x49, 0x08, 0x2d, 0x32, 0x6b, 0x1d, 0xbf, 0xb6, 0x5d, 0x28, 0x55,
+        };
+        return {reinterpret_cast<const char*>(content.data()), content.size()};
+    }
+
     CryptoGuardCtx ctx_;
 };
 
@@ -61,6 +70,69 @@ TEST_F(CryptoGuardCtxTest, encrypt_decrypt_file_with_different_passwords) {
     ASSERT_NE(encrypted_file_content.view(), file_content.view());
     std::stringstream decrypted_file_content;
     ASSERT_THROW(ctx_.DecryptFile(encrypted_file_content, decrypted_file_content, decrypt_pass), std::runtime_error);
+    ASSERT_TRUE(decrypted_file_content.view().empty());
+}
+
+TEST_F(CryptoGuardCtxTest, check_password_and_rewind_input_file) {
+    constexpr std::string_view prefix = "prefix";
+    std::stringstream file_content{GenerateRandomFileContent(1024)};
+    std::stringstream encrypted_file_content;
+    encrypted_file_content << prefix;
+    ctx_.EncryptFile(file_content, encrypted_file_content, "pass1");
+    encrypted_file_content.seekg(prefix.size());
+
+    try {
+        ctx_.CheckPassword(encrypted_file_content, "pass2");
+        FAIL() << "Wrong password was accepted";
+    } catch (const std::runtime_error& e) {
+        ASSERT_STREQ(e.what(), "Invalid password");
+    }
+    ASSERT_EQ(encrypted_file_content.tellg(), prefix.size());
+
+    ASSERT_NO_THROW(ctx_.CheckPassword(encrypted_file_content, "pass1"));
+    ASSERT_EQ(encrypted_file_content.tellg(), prefix.size());
+    std::stringstream decrypted_file_content;
+    ctx_.DecryptFile(encrypted_file_content, decrypted_file_content, "pass1");
+    ASSERT_EQ(decrypted_file_content.view(), file_content.view());
+}
+
+TEST_F(CryptoGuardCtxTest, check_password_of_file_without_header) {
+    std::stringstream encrypted_file_content{LegacyEncryptedFileContent()};
+    ASSERT_NO_THROW(ctx_.CheckPassword(encrypted_file_content, "any"));
+    ASSERT_EQ(encrypted_file_content.tellg(), 0);
+    std::stringstream decrypted_file_content;
+    ctx_.DecryptFile(encrypted_file_content, decrypted_file_content, "pass");
+    ASSERT_EQ(decrypted_file_content.view(), "Test string");
+}
+
+TEST_F(CryptoGuardCtxTest, encrypt_same_file_twice) {
+    constexpr auto pass = "pass";
+    std::stringstream file_content{GenerateRandomFileContent(1024)};
+    std::stringstream first_encrypted_file_content;
+    ctx_.EncryptFile(file_content, first_encrypted_file_content, pass);
+    file_content.clear();
+    file_content.seekg(0, std::ios::beg);
+    std::stringstream second_encrypted_file_content;
+    ctx_.EncryptFile(file_content, second_encrypted_file_content, pass);
+    ASSERT_NE(first_encrypted_file_content.view(), second_encrypted_file_content.view());
+}
+
+TEST_F(CryptoGuardCtxTest, encrypted_size) {
+    constexpr auto pass = "pass";
+    for (const size_t size : {0, 1, 15, 16, 17, 1025 * 1023}) {
+        std::stringstream file_content{GenerateRandomFileContent(size)};
+        std::stringstream encrypted_file_content;
+        ctx_.EncryptFile(file_content, encrypted_file_content, pass);
+        ASSERT_EQ(encrypted_file_content.view().size(), CryptoGuardCtx::GetEncryptedSize(size)) << size;
+    }
+}
+
+TEST_F(CryptoGuardCtxTest, decrypt_file_without_header) {
+    constexpr auto pass = "pass";
+    std::stringstream encrypted_file_content{LegacyEncryptedFileContent()};
+    std::stringstream decrypted_file_content;
+    ctx_.DecryptFile(encrypted_file_content, decrypted_file_content, pass);
+    ASSERT_EQ(decrypted_file_content.view(), "Test string");
 }
 
 TEST_F(CryptoGuardCtxTest, try_to_encrypt_invalid_input_file) {
@@ -0,0 +1,149 @@
+#include "crypto_archive.h"
+#include "temp_dir_test.h"
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+namespace crypto_guard::test {
+
+class CryptoArchiveTest : public TempDirTest {
+public:
+    static std::string GenerateRandomFileContent(size_t len) {
+        std::string content(len, '\0');
+        for (auto& ch : content) {
+            ch = static_cast<char>(lrand48() % 256);
+        }
+        return content;
+    }
+
+    void SetUp() override {
+        TempDirTest::SetUp();
+        input_dir_ = root_dir_ / "input";
+        output_dir_ = root_dir_ / "output";
+        archive_path_ = root_dir_ / "archive.cga";
+
+        files_["a.txt"] = GenerateRandomFileContent(1025 * 1023 * 3);
+        files_["empty"] = "";
+        files_["nested/b.bin"] = GenerateRandomFileContent(16);
+        files_["nested/deeper/c.bin"] = GenerateRandomFileContent(100);
+        for (const auto& [name, content] : files_) {
+            WriteFile(input_dir_ / name, content);
+        }
+    }
+
+    static constexpr size_t kThreadsCount{4};
+
+    std::filesystem::path input_dir_;
+    std::filesystem::path output_dir_;
+    std::filesystem::path archive_path_;
+    std::map<std::string, std::string> files_;
+};
+
+TEST_F(CryptoArchiveTest, pack_and_extract_directory) {
+    constexpr auto pass = "pass";
+    CryptoArchive::Pack(input_dir_, archive_path_, pass, kThreadsCount);
+    CryptoArchive::Extract(archive_path_, output_dir_, pass);
+    for (const auto& [name, content] : files_) {
+        ASSERT_EQ(ReadFile(output_dir_ / name), content) << name;
+    }
+}
+
+TEST_F(CryptoArchiveTest, pack_and_extract_single_file) {
+    constexpr auto pass = "pass";
+    CryptoArchive::Pack(input_dir_ / "nested/b.bin", archive_path_, pass, kThreadsCount);
+    CryptoArchive::Extract(archive_path_, output_dir_, pass);
+    ASSERT_EQ(ReadFile(output_dir_ / "b.bin"), files_["nested/b.bin"]);
+}
+
+TEST_F(CryptoArchiveTest, pack_and_extract_with_single_thread) {
+    constexpr auto pass = "pass";
+    CryptoArchive::Pack(input_dir_, archive_path_, pass, 1);
+    CryptoArchive::Extract(archive_path_, output_dir_, pass);
+    for (const auto& [name, content] : files_) {
+        ASSERT_EQ(ReadFile(output_dir_ / name), content) << name;
+    }
+}
+
+TEST_F(CryptoArchiveTest, pack_without_temporary_files_left) {
+    CryptoArchive::Pack(input_dir_, archive_path_, "pass", kThreadsCount);
+    std::vector<std::filesystem::path> root_entries{std::filesystem::directory_iterator{root_dir_}, {}};
+    std::ranges::sort(root_entries);
+    const std::vector<std::filesystem::path> expected_entries{archive_path_, input_dir_};
+    ASSERT_EQ(root_entries, expected_entries);
+}
+
+TEST_F(CryptoArchiveTest, read_index) {
+    constexpr auto pass = "pass";
+    CryptoArchive::Pack(input_dir_, archive_path_, pass, kThreadsCount);
+    std::ifstream archive{archive_path_, std::ios::binary};
+    const auto entries = CryptoArchive::ReadIndex(archive, pass);
+    ASSERT_EQ(entries.size(), files_.size());
+    for (const auto& entry : entries) {
+        ASSERT_TRUE(files_.contains(entry.name)) << entry.name;
+        ASSERT_EQ(entry.original_size, files_[entry.name].size());
+    }
+}
+
+TEST_F(CryptoArchiveTest, extract_single_member) {
+    constexpr auto pass = "pass";
+    CryptoArchive::Pack(input_dir_, archive_path_, pass, kThreadsCount);
+    CryptoArchive::Extract(archive_path_, output_dir_, pass, "nested/deeper/c.bin");
+    ASSERT_EQ(ReadFile(output_dir_ / "nested/deeper/c.bin"), files_["nested/deeper/c.bin"]);
+    ASSERT_FALSE(std::filesystem::exists(output_dir_ / "a.txt"));
+}
+
+TEST_F(CryptoArchiveTest, extract_member_to_stream) {
+    constexpr auto pass = "pass";
+    CryptoArchive::Pack(input_dir_, archive_path_, pass, kThreadsCount);
+    std::ifstream archive{archive_path_, std::ios::binary};
+    const auto entries = CryptoArchive::ReadIndex(archive, pass);
+    for (const auto& entry : entries) {
+        std::stringstream member_content;
+        CryptoArchive::ExtractMember(archive, entry, member_content, pass);
+        ASSERT_EQ(member_content.view(), files_[entry.name]) << entry.name;
+    }
+}
+
+TEST_F(CryptoArchiveTest, try_to_extract_missing_member) {
+    constexpr auto pass = "pass";
+    CryptoArchive::Pack(input_dir_, archive_path_, pass, kThreadsCount);
+    ASSERT_THROW(CryptoArchive::Extract(archive_path_, output_dir_, pass, "missing"), std::runtime_error);
+}
+
+TEST_F(CryptoArchiveTest, try_to_extract_with_different_password) {
+    CryptoArchive::Pack(input_dir_, archive_path_, "pass1", kThreadsCount);
+    ASSERT_THROW(CryptoArchive::Extract(archive_path_, output_dir_, "pass2"), std::runtime_error);
+}
+
+TEST_F(CryptoArchiveTest, try_to_extract_corrupted_member) {
+    constexpr auto pass = "pass";
+    CryptoArchive::Pack(input_dir_, archive_path_, pass, kThreadsCount);
+    {
+        std::fstream archive{archive_path_, std::ios::binary | std::ios::in | std::ios::out};
+        const auto entries = CryptoArchive::ReadIndex(archive, pass);
+        const auto entry = std::ranges::find(entries, "a.txt", &ArchiveEntry::name);
+        ASSERT_NE(entry, entries.end());
+        // Flips a byte of the password check in the member header
+        const auto check_offset = static_cast<std::streamoff>(entry->offset + 16);
+        archive.seekg(check_offset);
+        const auto check_byte = archive.get();
+        archive.seekp(check_offset);
+        archive.put(static_cast<char>(~check_byte));
+    }
+    ASSERT_THROW(CryptoArchive::Extract(archive_path_, output_dir_, pass, "a.txt"), std::runtime_error);
+    ASSERT_FALSE(std::filesystem::exists(output_dir_ / "a.txt"));
+}
+
+TEST_F(CryptoArchiveTest, try_to_extract_not_archive) {
+    ASSERT_THROW(CryptoArchive::Extract(input_dir_ / "a.txt", output_dir_, "pass"), std::runtime_error);
+}
+
+TEST_F(CryptoArchiveTest, try_to_pack_missing_input) {
+    ASSERT_THROW(CryptoArchive::Pack(root_dir_ / "missing", archive_path_, "pass", kThreadsCount), std::runtime_error);
+}
+
+}  // namespace crypto_guard::test
@@ -0,0 +1,158 @@
+#include "directory_watcher.h"
+#include "temp_dir_test.h"
+
+#include <future>
+#include <map>
+#include <mutex>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+namespace crypto_guard::test {
+
+class DirectoryWatcherTest : public TempDirTest {
+public:
+    void SetUp() override {
+        TempDirTest::SetUp();
+        watched_dir_ = root_dir_ / "watched";
+        std::filesystem::create_directories(watched_dir_);
+    }
+
+    DirectoryWatcher CreateWatcher(size_t workers_count, DirectoryWatcher::FileHandler file_handler = {},
+                                   bool handle_existing_files = false) {
+        if (!file_handler) {
+            file_handler = [this](CryptoGuardCtx&, const std::filesystem::path& file) { CountHandledFile(file); };
+        }
+        return DirectoryWatcher{watched_dir_, workers_count, handle_existing_files, std::move(file_handler),
+                                [this](const std::filesystem::path& file, const std::exception&) {
+                                    const std::lock_guard lock{mutex_};
+                                    ++failed_files_[file.filename().string()];
+                                }};
+    }
+
+    int CountHandledFile(const std::filesystem::path& file) {
+        const std::lock_guard lock{mutex_};
+        return ++handled_files_[file.filename().string()];
+    }
+
+    std::filesystem::path watched_dir_;
+    std::mutex mutex_;
+    std::map<std::string, int> handled_files_;
+    std::map<std::string, int> failed_files_;
+};
+
+TEST_F(DirectoryWatcherTest, handle_written_and_moved_files) {
+    auto watcher = CreateWatcher(4);
+    std::jthread watching_thread{[&watcher] { watcher.Run(); }};
+
+    WriteFile(watched_dir_ / "written", "content");
+    WriteFile(root_dir_ / "moved", "content");
+    std::filesystem::rename(root_dir_ / "moved", watched_dir_ / "moved");
+    std::filesystem::create_directory(watched_dir_ / "dir");
+
+    watcher.Stop();
+    watching_thread.join();
+    const std::map<std::string, int> expected_files{{"written", 1}, {"moved", 1}};
+    ASSERT_EQ(handled_files_, expected_files);
+}
+
+TEST_F(DirectoryWatcherTest, handle_files_existing_before_run) {
+    WriteFile(watched_dir_ / "first", "content");
+    WriteFile(watched_dir_ / "second", "content");
+    std::filesystem::create_directory(watched_dir_ / "dir");
+    auto watcher = CreateWatcher(2, {}, true);
+
+    watcher.Stop();
+    watcher.Run();
+    const std::map<std::string, int> expected_files{{"first", 1}, {"second", 1}};
+    ASSERT_EQ(handled_files_, expected_files);
+}
+
+TEST_F(DirectoryWatcherTest, skip_files_existing_before_run_by_default) {
+    WriteFile(watched_dir_ / "existing", "content");
+    auto watcher = CreateWatcher(2);
+
+    watcher.Stop();
+    watcher.Run();
+    ASSERT_TRUE(handled_files_.empty());
+}
+
+TEST_F(DirectoryWatcherTest, coalesce_events_of_queued_file) {
+    std::promise<void> handling_started;
+    std::promise<void> release_blocking_file;
+    auto watcher = CreateWatcher(1, [&](CryptoGuardCtx&, const std::filesystem::path& file) {
+        if (file.filename() == "blocking") {
+            handling_started.set_value();
+            release_blocking_file.get_future().wait();
+        }
+        CountHandledFile(file);
+    });
+    std::jthread watching_thread{[&watcher] { watcher.Run(); }};
+
+    WriteFile(watched_dir_ / "blocking", "content");
+    handling_started.get_future().wait();
+    for (int i = 0; i < 10; ++i) {
+        WriteFile(watched_dir_ / "coalesced", std::to_string(i));
+    }
+    WriteFile(watched_dir_ / "sentinel", "content");
+
+    // Events are read in order, so all the events of the coalesced file are read once the sentinel is queued
+    while (watcher.GetQueuedFilesCount() < 2) {
+        std::this_thread::yield();
+    }
+    watcher.Stop();
+    release_blocking_file.set_value();
+    watching_thread.join();
+    const std::map<std::string, int> expected_files{{"blocking", 1}, {"coalesced", 1}, {"sentinel", 1}};
+    ASSERT_EQ(handled_files_, expected_files);
+}
+
+TEST_F(DirectoryWatcherTest, handle_file_changed_while_handling_again) {
+    std::promise<void> handling_started;
+    std::promise<void> release_handling;
+    auto release_handling_future = release_handling.get_future().share();
+    auto watcher = CreateWatcher(2, [&](CryptoGuardCtx&, const std::filesystem::path& file) {
+        if (CountHandledFile(file) == 1) {
+            handling_started.set_value();
+            release_handling_future.wait();
+        }
+    });
+    std::jthread watching_thread{[&watcher] { watcher.Run(); }};
+
+    WriteFile(watched_dir_ / "changed", "first");
+    handling_started.get_future().wait();
+    WriteFile(watched_dir_ / "changed", "second");
+
+    watcher.Stop();
+    release_handling.set_value();
+    watching_thread.join();
+    const std::map<std::string, int> expected_files{{"changed", 2}};
+    ASSERT_EQ(handled_files_, expected_files);
+}
+
+TEST_F(DirectoryWatcherTest, report_handling_errors) {
+    auto watcher = CreateWatcher(
+        2, [](CryptoGuardCtx&, const std::filesystem::path&) { throw std::runtime_error("Handling error"); });
+    std::jthread watching_thread{[&watcher] { watcher.Run(); }};
+
+    WriteFile(watched_dir_ / "failed", "content");
+
+    watcher.Stop();
+    watching_thread.join();
+    const std::map<std::string, int> expected_files{{"failed", 1}};
+    ASSERT_EQ(failed_files_, expected_files);
+}
+
+TEST_F(DirectoryWatcherTest, stop_before_run) {
+    auto watcher = CreateWatcher(2);
+    watcher.Stop();
+    watcher.Run();
+    ASSERT_TRUE(handled_files_.empty());
+}
+
+TEST_F(DirectoryWatcherTest, try_to_watch_missing_directory) {
+    watched_dir_ = root_dir_ / "missing";
+    ASSERT_THROW(CreateWatcher(2), std::runtime_error);
+}
+
+}  // namespace crypto_guard::test
@@ -140,4 +140,185 @@ TEST_F(ProgramOptionsTest, checksum_command_with_all_options) {
     ASSERT_FALSE(po.IsHelp());
 }
 
+TEST_F(ProgramOptionsTest, checksum_command_with_cached) {
+    test_options_["--command"] = "checksum";
+    test_options_["--input"] = "input.txt";
+    test_options_["--cached"];
+    const auto res = ParseTestOptions();
+    ASSERT_TRUE(res.has_value());
+    const auto& po = res.value();
+    ASSERT_EQ(po.GetCommand(), ProgramOptions::CommandType::checksum);
+    ASSERT_TRUE(po.IsCached());
+    ASSERT_FALSE(po.IsVerify());
+}
+
+TEST_F(ProgramOptionsTest, checksum_command_with_verify) {
+    test_options_["--command"] = "checksum";
+    test_options_["--input"] = "input.txt";
+    test_options_["--verify"];
+    const auto res = ParseTestOptions();
+    ASSERT_TRUE(res.has_value());
+    const auto& po = res.value();
+    ASSERT_EQ(po.GetCommand(), ProgramOptions::CommandType::checksum);
+    ASSERT_FALSE(po.IsCached());
+    ASSERT_TRUE(po.IsVerify());
+}
+
+TEST_F(ProgramOptionsTest, checksum_command_with_cached_and_verify) {
+    test_options_["--command"] = "checksum";
+    test_options_["--input"] = "input.txt";
+    test_options_["--cached"];
+    test_options_["--verify"];
+    const auto res = ParseTestOptions();
+    ASSERT_FALSE(res.has_value());
+    ASSERT_TRUE(res.error().find("mutually exclusive") != std::string_view::npos);
+}
+
+TEST_F(ProgramOptionsTest, encrypt_command_with_cached) {
+    test_options_["--command"] = "encrypt";
+    test_options_["--input"] = "input.txt";
+    test_options_["--output"] = "output";
+    test_options_["--cached"];
+    const auto res = ParseTestOptions();
+    ASSERT_FALSE(res.has_value());
+    ASSERT_TRUE(res.error().find("--cached") != std::string_view::npos);
+}
+
+TEST_F(ProgramOptionsTest, archive_command_with_verify) {
+    test_options_["--command"] = "archive";
+    test_options_["--input"] = "input_dir";
+    test_options_["--output"] = "archive.cga";
+    test_options_["--verify"];
+    const auto res = ParseTestOptions();
+    ASSERT_FALSE(res.has_value());
+    ASSERT_TRUE(res.error().find("--verify") != std::string_view::npos);
+}
+
+TEST_F(ProgramOptionsTest, encrypt_command_with_watch) {
+    constexpr auto option_input = "input_dir";
+    constexpr auto option_output = "output_dir";
+    test_options_["--command"] = "encrypt";
+    test_options_["--input"] = option_input;
+    test_options_["--output"] = option_output;
+    test_options_["--watch"];
+    test_options_["--existing"];
+    test_options_["--threads"] = "2";
+    const auto res = ParseTestOptions();
+    ASSERT_TRUE(res.has_value());
+    const auto& po = res.value();
+    ASSERT_EQ(po.GetCommand(), ProgramOptions::CommandType::encrypt);
+    ASSERT_EQ(po.GetInputFile(), option_input);
+    ASSERT_EQ(po.GetOutputFile(), option_output);
+    ASSERT_EQ(po.GetThreadsCount(), 2);
+    ASSERT_TRUE(po.IsWatch());
+    ASSERT_TRUE(po.IsExisting());
+}
+
+TEST_F(ProgramOptionsTest, checksum_command_with_watch) {
+    test_options_["--command"] = "checksum";
+    test_options_["--input"] = "input_dir";
+    test_options_["-w"];
+    const auto res = ParseTestOptions();
+    ASSERT_TRUE(res.has_value());
+    const auto& po = res.value();
+    ASSERT_EQ(po.GetCommand(), ProgramOptions::CommandType::checksum);
+    ASSERT_TRUE(po.IsWatch());
+}
+
+TEST_F(ProgramOptionsTest, checksum_command_with_cached_and_watch) {
+    test_options_["--command"] = "checksum";
+    test_options_["--input"] = "input_dir";
+    test_options_["--cached"];
+    test_options_["--watch"];
+    const auto res = ParseTestOptions();
+    ASSERT_FALSE(res.has_value());
+    ASSERT_TRUE(res.error().find("--watch") != std::string_view::npos);
+}
+
+TEST_F(ProgramOptionsTest, encrypt_command_with_existing_without_watch) {
+    test_options_["--command"] = "encrypt";
+    test_options_["--input"] = "input_dir";
+    test_options_["--output"] = "output_dir";
+    test_options_["--existing"];
+    const auto res = ParseTestOptions();
+    ASSERT_FALSE(res.has_value());
+    ASSERT_TRUE(res.error().find("--existing") != std::string_view::npos);
+}
+
+TEST_F(ProgramOptionsTest, decrypt_command_with_watch) {
+    test_options_["--command"] = "decrypt";
+    test_options_["--input"] = "input_dir";
+    test_options_["--output"] = "output_dir";
+    test_options_["--watch"];
+    const auto res = ParseTestOptions();
+    ASSERT_FALSE(res.has_value());
+    ASSERT_TRUE(res.error().find("--watch") != std::string_view::npos);
+}
+
+TEST_F(ProgramOptionsTest, archive_command_with_all_options) {
+    constexpr auto option_input = "input_dir";
+    constexpr auto option_output = "archive.cga";
+    constexpr auto option_password = "pass";
+    test_options_["--command"] = "archive";
+    test_options_["--input"] = option_input;
+    test_options_["--output"] = option_output;
+    test_options_["--password"] = option_password;
+    test_options_["--threads"] = "3";
+    const auto res = ParseTestOptions();
+    ASSERT_TRUE(res.has_value());
+    const auto& po = res.value();
+    ASSERT_EQ(po.GetCommand(), ProgramOptions::CommandType::archive);
+    ASSERT_EQ(po.GetInputFile(), option_input);
+    ASSERT_EQ(po.GetOutputFile(), option_output);
+    ASSERT_EQ(po.GetPassword(), option_password);
+    ASSERT_EQ(po.GetThreadsCount(), 3);
+    ASSERT_FALSE(po.IsHelp());
+}
+
+TEST_F(ProgramOptionsTest, extract_command_with_member) {
+    constexpr auto option_input = "archive.cga";
+    constexpr auto option_output = "output_dir";
+    constexpr auto option_member = "nested/file.txt";
+    test_options_["--command"] = "extract";
+    test_options_["--input"] = option_input;
+    test_options_["--output"] = option_output;
+    test_options_["--member"] = option_member;
+    const auto res = ParseTestOptions();
+    ASSERT_TRUE(res.has_value());
+    const auto& po = res.value();
+    ASSERT_EQ(po.GetCommand(), ProgramOptions::CommandType::extract);
+    ASSERT_EQ(po.GetInputFile(), option_input);
+    ASSERT_EQ(po.GetOutputFile(), option_output);
+    ASSERT_EQ(po.GetMember(), option_member);
+    ASSERT_FALSE(po.IsHelp());
+}
+
+TEST_F(ProgramOptionsTest, archive_command_with_member) {
+    test_options_["--command"] = "archive";
+    test_options_["--input"] = "input_dir";
+    test_options_["--output"] = "archive.cga";
+    test_options_["--member"] = "file.txt";
+    const auto res = ParseTestOptions();
+    ASSERT_FALSE(res.has_value());
+    ASSERT_TRUE(res.error().find("--member") != std::string_view::npos);
+}
+
+TEST_F(ProgramOptionsTest, extract_command_with_threads) {
+    test_options_["--command"] = "extract";
+    test_options_["--input"] = "archive.cga";
+    test_options_["--output"] = "output_dir";
+    test_options_["--threads"] = "2";
+    const auto res = ParseTestOptions();
+    ASSERT_FALSE(res.has_value());
+    ASSERT_TRUE(res.error().find("--threads") != std::string_view::npos);
+}
+
+TEST_F(ProgramOptionsTest, extract_command_without_output) {
+    test_options_["--command"] = "extract";
+    test_options_["--input"] = "archive.cga";
+    const auto res = ParseTestOptions();
+    ASSERT_FALSE(res.has_value());
+    ASSERT_TRUE(res.error().find("is required but missing") != std::string_view::npos);
+}
+
 }  // namespace crypto_guard::test
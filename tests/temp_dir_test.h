@@ -0,0 +1,43 @@
+#pragma once
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include <gtest/gtest.h>
+
+namespace crypto_guard::test {
+
+// Fixture that gives every test its own empty directory, removed after the test
+class TempDirTest : public ::testing::Test {
+public:
+    static void WriteFile(const std::filesystem::path& path, std::string_view content) {
+        std::filesystem::create_directories(path.parent_path());
+        std::ofstream file{path, std::ios::binary | std::ios::trunc};
+        file.write(content.data(), static_cast<std::streamsize>(content.size()));
+    }
+
+    static std::string ReadFile(const std::filesystem::path& path) {
+        std::ifstream file{path, std::ios::binary};
+        std::stringstream ss;
+        ss << file.rdbuf();
+        return ss.str();
+    }
+
+    void SetUp() override {
+        const auto* test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+        root_dir_ = std::filesystem::temp_directory_path() /
+                    std::format("crypto_guard_{}_{}", test_info->test_suite_name(), test_info->name());
+        std::filesystem::remove_all(root_dir_);
+        std::filesystem::create_directories(root_dir_);
+    }
+
+    void TearDown() override { std::filesystem::remove_all(root_dir_); }
+
+    std::filesystem::path root_dir_;
+};
+
+}  // namespace crypto_guard::test